@@ -0,0 +1,133 @@
+/*
+ *  Application note: ESP32-CAPTIVE-PORTAL
+ *  Asynchronous binary event log
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Arduino.h>
+#include <atomic>
+#include "EventLog.h"
+
+static const uint32_t LogRingSize = 64;   // Must be a power of two
+static const uint32_t LogIdleDelay = 10;  // ms the log task sleeps when the ring is empty
+
+struct LogEvent {
+  uint32_t Time;
+  uintptr_t Arg[2];
+  uint8_t Id;
+};
+
+// How the arguments of an event are passed to its format
+enum LogArgKind : uint8_t {
+  LOG_ARG_UINT,         // Arg0 and Arg1 as %u
+  LOG_ARG_IP,           // Arg0 is an IPv4 address, printed as dotted quad after the text
+  LOG_ARG_TEXT          // Arg0 as %s (string literal), Arg1 as %u
+};
+
+struct LogEventInfo {
+  const char* Format;   // printf format for Arg0 and Arg1
+  LogArgKind Kind;
+};
+
+static const LogEventInfo LogEvents[EV_COUNT] = {
+  { "Request redirected to captive portal", LOG_ARG_UINT }, // EV_CP_REDIRECT
+  { "IP: ", LOG_ARG_IP },                                   // EV_STATIC_IP
+  { "GW: ", LOG_ARG_IP },                                   // EV_STATIC_GW
+  { "SN: ", LOG_ARG_IP },                                   // EV_STATIC_SN
+  { "DNS: ", LOG_ARG_IP },                                  // EV_STATIC_DNS
+  { "Initalizing Wifi Client.", LOG_ARG_UINT },             // EV_STA_INIT
+  { "Connecting, retry %u status %u", LOG_ARG_UINT },       // EV_STA_RETRY
+  { "Wifi Client status %u", LOG_ARG_UINT },                // EV_STA_RESULT
+  { "STA Pwd Err", LOG_ARG_UINT },                          // EV_STA_PWD_ERROR
+  { "Error: MDNS", LOG_ARG_UINT },                          // EV_MDNS_ERROR
+  { "Firmware update started.", LOG_ARG_UINT },             // EV_OTA_START
+  { "Update: %u bytes written", LOG_ARG_UINT },             // EV_OTA_PROGRESS
+  { "Firmware update: %s, error %u", LOG_ARG_TEXT },        // EV_OTA_RESULT
+};
+
+// Single producer / single consumer ring. Head is only written by the producer, tail only by the log task.
+static LogEvent LogRing[LogRingSize];
+static std::atomic<uint32_t> LogHead(0);
+static std::atomic<uint32_t> LogTail(0);
+static std::atomic<uint32_t> LogDroppedCount(0);
+
+void logEvent(uint8_t id, uintptr_t arg0, uintptr_t arg1) {
+  uint32_t head = LogHead.load(std::memory_order_relaxed);
+  if (head - LogTail.load(std::memory_order_acquire) >= LogRingSize) {
+    LogDroppedCount.store(LogDroppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return;
+  }
+  LogEvent& ev = LogRing[head & (LogRingSize - 1)];
+  ev.Time = millis();
+  ev.Arg[0] = arg0;
+  ev.Arg[1] = arg1;
+  ev.Id = id;
+  LogHead.store(head + 1, std::memory_order_release);
+}
+
+uint32_t logDropped() {
+  return LogDroppedCount.load(std::memory_order_relaxed);
+}
+
+// Format the event first and print it with one Serial call, so lines of other tasks are not split
+static void printEvent(const LogEvent& ev) {
+  char text[96];
+  if (ev.Id >= EV_COUNT) {
+    snprintf(text, sizeof(text), "Unknown event %u", ev.Id);
+  }
+  else if (LogEvents[ev.Id].Kind == LOG_ARG_IP) {
+    uint32_t ip = ev.Arg[0];
+    snprintf(text, sizeof(text), "%s%u.%u.%u.%u", LogEvents[ev.Id].Format, (unsigned)(ip & 0xFF), (unsigned)((ip >> 8) & 0xFF), (unsigned)((ip >> 16) & 0xFF), (unsigned)(ip >> 24));
+  }
+  else if (LogEvents[ev.Id].Kind == LOG_ARG_TEXT) {
+    snprintf(text, sizeof(text), LogEvents[ev.Id].Format, (const char*)ev.Arg[0], (unsigned)ev.Arg[1]);
+  }
+  else {
+    snprintf(text, sizeof(text), LogEvents[ev.Id].Format, (unsigned)ev.Arg[0], (unsigned)ev.Arg[1]);
+  }
+  Serial.printf("[%u] %s\n", (unsigned)ev.Time, text);
+}
+
+// Drain the ring to Serial, the UART may block here instead of in the web server
+static void logTask(void*) {
+  uint32_t reported = 0;
+  for (;;) {
+    uint32_t tail = LogTail.load(std::memory_order_relaxed);
+    if (tail == LogHead.load(std::memory_order_acquire)) {
+      uint32_t dropped = logDropped();
+      if (dropped != reported) {
+        Serial.printf("Log: %u events dropped\n", (unsigned)(dropped - reported));
+        reported = dropped;
+      }
+      vTaskDelay(pdMS_TO_TICKS(LogIdleDelay));
+      continue;
+    }
+    LogEvent ev = LogRing[tail & (LogRingSize - 1)];
+    printEvent(ev);
+    LogTail.store(tail + 1, std::memory_order_release); // Only after printing, so logFlush() sees the line written
+  }
+}
+
+void logFlush(uint32_t timeout) {
+  uint32_t start = millis();
+  while (LogTail.load(std::memory_order_acquire) != LogHead.load(std::memory_order_relaxed) && millis() - start < timeout) {
+    vTaskDelay(pdMS_TO_TICKS(1));
+  }
+}
+
+void logBegin() {
+  // Lowest priority on the core not running the Arduino loop
+  xTaskCreatePinnedToCore(logTask, "EventLog", 3072, NULL, tskIDLE_PRIORITY, NULL, 0);
+}
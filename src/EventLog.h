@@ -0,0 +1,77 @@
+/*
+ *  Application note: ESP32-CAPTIVE-PORTAL
+ *  Asynchronous binary event log
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdint.h>
+
+#define CPLOG_LEVEL_NONE  0
+#define CPLOG_LEVEL_ERROR 1
+#define CPLOG_LEVEL_INFO  2
+#define CPLOG_LEVEL_DEBUG 3
+
+// Events above this level are removed at compile time, including their arguments
+#ifndef CPLOG_LEVEL
+#define CPLOG_LEVEL CPLOG_LEVEL_INFO
+#endif
+
+// Event IDs, the text for each is in LogEvents[] in EventLog.cpp
+enum LogEventId : uint8_t {
+  EV_CP_REDIRECT,     // Request redirected to captive portal
+  EV_STATIC_IP,       // Arg0: IP
+  EV_STATIC_GW,       // Arg0: IP
+  EV_STATIC_SN,       // Arg0: IP
+  EV_STATIC_DNS,      // Arg0: IP
+  EV_STA_INIT,        // Initalizing Wifi Client
+  EV_STA_RETRY,       // Arg0: retry, Arg1: connection status
+  EV_STA_RESULT,      // Arg0: connection status
+  EV_STA_PWD_ERROR,
+  EV_MDNS_ERROR,
+  EV_OTA_START,
+  EV_OTA_PROGRESS,    // Arg0: bytes written
+  EV_OTA_RESULT,      // Arg0: result text (string literal), Arg1: partition error
+  EV_COUNT
+};
+
+// Queue an event for the log task. Never blocks, if the ring is full the event is dropped and counted.
+// Only to be called from one task (the Arduino loop). Text arguments must be string literals.
+void logEvent(uint8_t id, uintptr_t arg0 = 0, uintptr_t arg1 = 0);
+// Start the low priority task which prints queued events on Serial
+void logBegin();
+// Wait until the log task has printed all queued events, at most timeout ms. Used before direct Serial output.
+void logFlush(uint32_t timeout = 1000);
+uint32_t logDropped();
+
+#if CPLOG_LEVEL >= CPLOG_LEVEL_ERROR
+#define CPLOG_E(...) logEvent(__VA_ARGS__)
+#else
+#define CPLOG_E(...) do {} while (0)
+#endif
+#if CPLOG_LEVEL >= CPLOG_LEVEL_INFO
+#define CPLOG_I(...) logEvent(__VA_ARGS__)
+#else
+#define CPLOG_I(...) do {} while (0)
+#endif
+#if CPLOG_LEVEL >= CPLOG_LEVEL_DEBUG
+#define CPLOG_D(...) logEvent(__VA_ARGS__)
+#else
+#define CPLOG_D(...) do {} while (0)
+#endif
+
+#endif
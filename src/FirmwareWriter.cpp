@@ -0,0 +1,114 @@
+/*
+ *  Application note: ESP32-CAPTIVE-PORTAL
+ *  Firmware image writer for OTA updates
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "FirmwareWriter.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+bool FirmwareWriter::begin(const char* sha256) {
+  if (_running || _partition.isRunning()) { // Left over from an upload which never finished
+    abort(NULL);
+  }
+  reset();
+  if (sha256 == NULL || strlen(sha256) != 64) {
+    _error = "SHA-256 of the image is required";
+    return false;
+  }
+  for (int i = 0; i < 64; i++) {
+    if (!isxdigit((unsigned char)sha256[i])) {
+      _error = "SHA-256 of the image is invalid";
+      return false;
+    }
+    _expected[i] = tolower((unsigned char)sha256[i]);
+  }
+  _expected[64] = '\0';
+  if (!_partition.begin()) {
+    _partitionError = _partition.error();
+    _error = "No OTA partition available";
+    return false;
+  }
+  mbedtls_sha256_init(&_sha);
+  mbedtls_sha256_starts(&_sha, 0);
+  _running = true;
+  return true;
+}
+
+bool FirmwareWriter::write(const uint8_t* data, size_t len) {
+  if (!_running) {
+    return false; // Already failed, discard the rest of the upload
+  }
+  mbedtls_sha256_update(&_sha, data, len);
+  if (_partition.write(data, len) != len) {
+    fail("Flash write error");
+    return false;
+  }
+  _written += len;
+  return true;
+}
+
+bool FirmwareWriter::end() {
+  if (!_running) {
+    return false;
+  }
+  uint8_t digest[32];
+  char hex[65];
+  mbedtls_sha256_finish(&_sha, digest);
+  mbedtls_sha256_free(&_sha);
+  _running = false;
+  for (int i = 0; i < 32; i++) {
+    sprintf(&hex[i * 2], "%02x", digest[i]);
+  }
+  // Verify the image before the partition switches the boot partition
+  if (strcmp(hex, _expected) != 0) {
+    _error = "SHA-256 mismatch";
+    _partition.abort();
+    return false;
+  }
+  if (!_partition.end()) {
+    _partitionError = _partition.error();
+    _error = "Image invalid";
+    return false;
+  }
+  _success = true;
+  return true;
+}
+
+void FirmwareWriter::abort(const char* reason) {
+  if (_running) {
+    mbedtls_sha256_free(&_sha);
+    _running = false;
+  }
+  if (_partition.isRunning()) {
+    _partition.abort();
+  }
+  _error = reason;
+}
+
+void FirmwareWriter::reset() {
+  _success = false;
+  _error = NULL;
+  _partitionError = 0;
+  _written = 0;
+}
+
+void FirmwareWriter::fail(const char* reason) {
+  _partitionError = _partition.error();
+  abort(reason);
+}
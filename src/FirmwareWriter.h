@@ -0,0 +1,70 @@
+/*
+ *  Application note: ESP32-CAPTIVE-PORTAL
+ *  Firmware image writer for OTA updates
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef FIRMWARE_WRITER_H
+#define FIRMWARE_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mbedtls/sha256.h"
+
+// Flash partition receiving the image. On the ESP32 this wraps Update, on the host a simulated partition.
+class PartitionWriter {
+  public:
+    virtual ~PartitionWriter() {}
+    virtual bool begin() = 0;                                  // Prepare the inactive partition
+    virtual size_t write(const uint8_t* data, size_t len) = 0;
+    virtual bool end() = 0;                                    // Check the image and make it the boot partition
+    virtual void abort() = 0;
+    virtual bool isRunning() = 0;
+    virtual uint8_t error() = 0;
+};
+
+// Writes an image chunk by chunk while hashing it with SHA-256. The partition is only
+// committed when the hash matches the expected one, RAM usage does not depend on the image size.
+class FirmwareWriter {
+  public:
+    explicit FirmwareWriter(PartitionWriter& partition) : _partition(partition) {}
+
+    bool begin(const char* sha256);                  // Expected SHA-256 as 64 hex characters
+    bool write(const uint8_t* data, size_t len);
+    bool end();                                      // Verify hash, then commit the partition
+    void abort(const char* reason);
+    void reset();                                    // Forget the result of the last update
+
+    bool running() const { return _running; }
+    bool success() const { return _success; }
+    const char* error() const { return _error; }     // Static text, NULL if no error occurred
+    uint8_t partitionError() const { return _partitionError; }
+    size_t written() const { return _written; }
+
+  private:
+    void fail(const char* reason);
+
+    PartitionWriter& _partition;
+    mbedtls_sha256_context _sha;
+    char _expected[65];
+    bool _running = false;
+    bool _success = false;
+    const char* _error = NULL;
+    uint8_t _partitionError = 0;
+    size_t _written = 0;
+};
+
+#endif
@@ -0,0 +1,202 @@
+/*
+ *  Application note: ESP32-CAPTIVE-PORTAL
+ *  Streaming gzip encoder for dynamic pages
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GzipStream.h"
+#include <string.h>
+
+static const uint16_t NoPos = 0xFFFF;
+static const size_t MinMatch = 3;
+static const size_t MaxMatch = 258;
+static const size_t MinLookahead = MaxMatch + MinMatch;
+
+// RFC 1951 3.2.5 length and distance codes
+static const uint16_t LengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DistBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// CRC-32 with a nibble table to keep flash usage small
+static const uint32_t CrcTable[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static inline uint16_t hash3(const uint8_t* p) {
+  uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+  return (uint16_t)((v * 2654435761u) >> 23) & (GzipStream::HashSize - 1);
+}
+
+GzipStream::GzipStream(Sink sink) : _sink(sink) {
+  for (size_t i = 0; i < HashSize; i++) {
+    _head[i] = NoPos;
+  }
+  // gzip header: deflate, no flags, no mtime, unknown OS
+  static const uint8_t header[10] = {0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF};
+  for (size_t i = 0; i < sizeof(header); i++) {
+    putByte(header[i]);
+  }
+  // Single final block with fixed Huffman codes, so no block boundaries are needed while streaming
+  putBits(1, 1);
+  putBits(1, 2);
+}
+
+void GzipStream::write(const uint8_t* data, size_t len) {
+  _total += len;
+  for (size_t i = 0; i < len; i++) {
+    _crc = CrcTable[(_crc ^ data[i]) & 0x0F] ^ (_crc >> 4);
+    _crc = CrcTable[(_crc ^ (data[i] >> 4)) & 0x0F] ^ (_crc >> 4);
+  }
+  while (len > 0) {
+    size_t n = sizeof(_buf) - _fill;
+    if (n > len) {
+      n = len;
+    }
+    memcpy(&_buf[_fill], data, n);
+    _fill += n;
+    data += n;
+    len -= n;
+    compress(false);
+    if (_fill == sizeof(_buf)) {
+      slide();
+    }
+  }
+}
+
+void GzipStream::finish() {
+  compress(true);
+  putCode(0, 7); // End of block
+  if (_bitCount > 0) {
+    putBits(0, 8 - _bitCount);
+  }
+  uint32_t crc = ~_crc;
+  for (int i = 0; i < 4; i++) {
+    putByte((crc >> (8 * i)) & 0xFF);
+  }
+  for (int i = 0; i < 4; i++) {
+    putByte((_total >> (8 * i)) & 0xFF);
+  }
+  flushOut();
+}
+
+// Encode buffered input. Without flush enough lookahead for a maximal match is kept back.
+void GzipStream::compress(bool flush) {
+  while (_pos < _fill && (flush || _fill - _pos >= MinLookahead)) {
+    size_t avail = _fill - _pos;
+    size_t best = 0;
+    size_t dist = 0;
+    if (avail >= MinMatch) {
+      uint16_t h = hash3(&_buf[_pos]);
+      uint16_t cand = _head[h];
+      _head[h] = _pos;
+      if (cand != NoPos) {
+        size_t limit = avail < MaxMatch ? avail : MaxMatch;
+        while (best < limit && _buf[cand + best] == _buf[_pos + best]) {
+          best++;
+        }
+        dist = _pos - cand;
+      }
+    }
+    if (best >= MinMatch) {
+      putMatch(best, dist);
+      // Index the positions covered by the match for later references
+      for (size_t i = 1; i < best; i++) {
+        if (_pos + i + MinMatch <= _fill) {
+          _head[hash3(&_buf[_pos + i])] = _pos + i;
+        }
+      }
+      _pos += best;
+    }
+    else {
+      putLiteral(_buf[_pos]);
+      _pos++;
+    }
+  }
+}
+
+// Drop the older half of the history buffer
+void GzipStream::slide() {
+  memmove(_buf, &_buf[WindowSize], _fill - WindowSize);
+  _fill -= WindowSize;
+  _pos -= WindowSize;
+  for (size_t i = 0; i < HashSize; i++) {
+    _head[i] = (_head[i] != NoPos && _head[i] >= WindowSize) ? _head[i] - WindowSize : NoPos;
+  }
+}
+
+void GzipStream::putBits(uint32_t value, uint8_t count) {
+  _bitBuf |= value << _bitCount;
+  _bitCount += count;
+  while (_bitCount >= 8) {
+    putByte(_bitBuf & 0xFF);
+    _bitBuf >>= 8;
+    _bitCount -= 8;
+  }
+}
+
+void GzipStream::putCode(uint32_t code, uint8_t count) {
+  uint32_t reversed = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    reversed = (reversed << 1) | ((code >> i) & 1);
+  }
+  putBits(reversed, count);
+}
+
+void GzipStream::putLiteral(uint8_t c) {
+  if (c < 144) {
+    putCode(0x30 + c, 8);
+  }
+  else {
+    putCode(0x190 + c - 144, 9);
+  }
+}
+
+void GzipStream::putMatch(uint16_t len, uint16_t dist) {
+  int i = 28;
+  while (LengthBase[i] > len) {
+    i--;
+  }
+  uint16_t sym = 257 + i;
+  if (sym < 280) {
+    putCode(sym - 256, 7);
+  }
+  else {
+    putCode(0xC0 + sym - 280, 8);
+  }
+  putBits(len - LengthBase[i], LengthExtra[i]);
+  int d = 29;
+  while (DistBase[d] > dist) {
+    d--;
+  }
+  putCode(d, 5);
+  putBits(dist - DistBase[d], DistExtra[d]);
+}
+
+void GzipStream::putByte(uint8_t c) {
+  _out[_outLen++] = c;
+  if (_outLen == OutSize) {
+    flushOut();
+  }
+}
+
+void GzipStream::flushOut() {
+  if (_outLen > 0) {
+    _sink(_out, _outLen);
+    _written += _outLen;
+    _outLen = 0;
+  }
+}
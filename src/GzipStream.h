@@ -0,0 +1,67 @@
+/*
+ *  Application note: ESP32-CAPTIVE-PORTAL
+ *  Streaming gzip encoder for dynamic pages
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GZIP_STREAM_H
+#define GZIP_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Deflate with fixed Huffman codes and a small sliding window. The encoder only keeps
+// the window, a hash table and one output block, so memory is fixed (about 4.5 KB)
+// regardless of the length of the body.
+class GzipStream {
+  public:
+    typedef void (*Sink)(const uint8_t* data, size_t len);
+
+    static const size_t WindowSize = 1024;       // Half of the history buffer
+    static const size_t HashSize = 512;
+    static const size_t OutSize = 1460;          // Compressed bytes handed to the sink at once, one TCP segment
+
+    explicit GzipStream(Sink sink);
+    void write(const uint8_t* data, size_t len);
+    void finish();                               // Flush remaining data and write gzip trailer
+
+    size_t bytesIn() const { return _total; }
+    size_t bytesOut() const { return _written; }
+
+  private:
+    void compress(bool flush);
+    void slide();
+    void putBits(uint32_t value, uint8_t count);
+    void putCode(uint32_t code, uint8_t count);  // Huffman code, most significant bit first
+    void putLiteral(uint8_t c);
+    void putMatch(uint16_t len, uint16_t dist);
+    void putByte(uint8_t c);
+    void flushOut();
+
+    Sink _sink;
+    uint8_t _buf[2 * WindowSize];
+    uint16_t _head[HashSize];
+    uint8_t _out[OutSize];
+    size_t _fill = 0;                            // Valid bytes in _buf
+    size_t _pos = 0;                             // Next byte in _buf to encode
+    size_t _outLen = 0;
+    uint32_t _bitBuf = 0;
+    uint8_t _bitCount = 0;
+    uint32_t _crc = 0xFFFFFFFF;
+    size_t _total = 0;
+    size_t _written = 0;
+};
+
+#endif
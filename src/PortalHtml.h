@@ -0,0 +1,36 @@
+/*
+ *  Application note: ESP32-CAPTIVE-PORTAL
+ *  HTML templates of the captive portal pages
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PORTAL_HTML_H
+#define PORTAL_HTML_H
+
+const char CPHTTP_HEAD[] PROGMEM            = "<!DOCTYPE html><html lang=\"en\"><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1, user-scalable=no\"/><title>{v}</title>";
+const char CPHTTP_STYLE[] PROGMEM           = "<style>.c{text-align: center;} div,input{padding:5px;font-size:1em;} input{width:95%;} body{text-align: center;font-family:verdana;} button{border:0;border-radius:0.3rem;background-color:#1fa3ec;color:#fff;line-height:2.4rem;font-size:1.2rem;width:100%;} .q{float: right;width: 64px;text-align: right;} .l{background: url(\"data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAACAAAAAgCAMAAABEpIrGAAAALVBMVEX///8EBwfBwsLw8PAzNjaCg4NTVVUjJiZDRUUUFxdiZGSho6OSk5Pg4eFydHTCjaf3AAAAZElEQVQ4je2NSw7AIAhEBamKn97/uMXEGBvozkWb9C2Zx4xzWykBhFAeYp9gkLyZE0zIMno9n4g19hmdY39scwqVkOXaxph0ZCXQcqxSpgQpONa59wkRDOL93eAXvimwlbPbwwVAegLS1HGfZAAAAABJRU5ErkJggg==\") no-repeat left center;background-size: 1em;}</style>";
+const char CPHTTP_SCRIPT[] PROGMEM          = "<script>function c(l){document.getElementById('s').value=l.innerText||l.textContent;document.getElementById('p').focus();}function hC(cb){this.open('?'+'sip='+cb.checked,'_self');}</script>";
+const char CPHTTP_HEAD_END[] PROGMEM        = "</head><body><div style='text-align:left;display:inline-block;min-width:260px;'>";
+const char CPHTTP_PORTAL_OPTIONS[] PROGMEM  = "<form action=\"/wifi\" method=\"get\"><button>Configure WiFi</button></form><br/><form action=\"/0wifi\" method=\"get\"><button>Configure WiFi (No Scan)</button></form><br/><form action=\"/reset\" method=\"get\"><button>Reset to default</button></form><br/><form action=\"/update\" method=\"get\"><button>Firmware update</button></form><br/>";
+const char CPHTTP_ITEM[] PROGMEM            = "<div><a href='#p' onclick='c(this)'>{v}</a>&nbsp;<span class='q {i}'>{r}%</span></div>";
+const char CPHTTP_FORM_START[] PROGMEM      = "<label><input style='width:10%' type='checkbox' onclick='hC(this)'> Static IP</label><form method='get' action='wifisave'><label><input style='width:10%' type='checkbox' id='ap' name='ap'> AP Mode</label><input id='s' name='s' length=32 placeholder='SSID'><br/><input id='p' name='p' length=64 type='password' placeholder='password'><br/><br/><input id='h' name='h' length=20 placeholder='hostname'><br/>";
+const char CPHTTP_FORM_PARAM[] PROGMEM      = "<br/><input id='{i}' name='{n}' length={l} placeholder='{p}' value='{v}'>";
+const char CPHTTP_FORM_END[] PROGMEM        = "<br/><button type='submit'>save</button></form>";
+const char CPHTTP_SCAN_LINK[] PROGMEM       = "<br/><div class=\"c\"><a href=\"/wifi\">Scan</a></div>";
+const char CPHTTP_UPDATE_FORM[] PROGMEM     = "<form method='post' enctype='multipart/form-data' onsubmit=\"this.action='/update?sha256='+document.getElementById('x').value;\"><input id='x' length=64 placeholder='SHA-256'><br/><input type='file' name='update'><br/><br/><button type='submit'>update</button></form>";
+const char CPHTTP_END[] PROGMEM             = "</div></body></html>";
+
+#endif
@@ -25,6 +25,11 @@
 #include <ESPmDNS.h>
 #include <DNSServer.h>
 #include <EEPROM.h>
+#include <new>
+#include <Update.h>
+#include "FirmwareWriter.h"
+#include "GzipStream.h"
+#include "EventLog.h"
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
 
@@ -33,19 +38,11 @@
 static const byte WiFiPwdLen = 25;
 static const byte APSTANameLen = 20;
 static const byte HostNameLen =20;
+static const size_t OTAProgressStep = 65536; // Report firmware upload progress every 64 KB
+static const size_t GzipMinSize = 1460;      // Bodies fitting into one TCP segment are sent uncompressed
 
 /*____Captiveportal____*/
-const char CPHTTP_HEAD[] PROGMEM            = "<!DOCTYPE html><html lang=\"en\"><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1, user-scalable=no\"/><title>{v}</title>";
-const char CPHTTP_STYLE[] PROGMEM           = "<style>.c{text-align: center;} div,input{padding:5px;font-size:1em;} input{width:95%;} body{text-align: center;font-family:verdana;} button{border:0;border-radius:0.3rem;background-color:#1fa3ec;color:#fff;line-height:2.4rem;font-size:1.2rem;width:100%;} .q{float: right;width: 64px;text-align: right;} .l{background: url(\"data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAACAAAAAgCAMAAABEpIrGAAAALVBMVEX///8EBwfBwsLw8PAzNjaCg4NTVVUjJiZDRUUUFxdiZGSho6OSk5Pg4eFydHTCjaf3AAAAZElEQVQ4je2NSw7AIAhEBamKn97/uMXEGBvozkWb9C2Zx4xzWykBhFAeYp9gkLyZE0zIMno9n4g19hmdY39scwqVkOXaxph0ZCXQcqxSpgQpONa59wkRDOL93eAXvimwlbPbwwVAegLS1HGfZAAAAABJRU5ErkJggg==\") no-repeat left center;background-size: 1em;}</style>";
-const char CPHTTP_SCRIPT[] PROGMEM          = "<script>function c(l){document.getElementById('s').value=l.innerText||l.textContent;document.getElementById('p').focus();}function hC(cb){this.open('?'+'sip='+cb.checked,'_self');}</script>";
-const char CPHTTP_HEAD_END[] PROGMEM        = "</head><body><div style='text-align:left;display:inline-block;min-width:260px;'>";
-const char CPHTTP_PORTAL_OPTIONS[] PROGMEM  = "<form action=\"/wifi\" method=\"get\"><button>Configure WiFi</button></form><br/><form action=\"/0wifi\" method=\"get\"><button>Configure WiFi (No Scan)</button></form><br/><form action=\"/reset\" method=\"get\"><button>Reset to default</button></form><br/>";
-const char CPHTTP_ITEM[] PROGMEM            = "<div><a href='#p' onclick='c(this)'>{v}</a>&nbsp;<span class='q {i}'>{r}%</span></div>";
-const char CPHTTP_FORM_START[] PROGMEM      = "<label><input style='width:10%' type='checkbox' onclick='hC(this)'> Static IP</label><form method='get' action='wifisave'><label><input style='width:10%' type='checkbox' id='ap' name='ap'> AP Mode</label><input id='s' name='s' length=32 placeholder='SSID'><br/><input id='p' name='p' length=64 type='password' placeholder='password'><br/><br/><input id='h' name='h' length=20 placeholder='hostname'><br/>";
-const char CPHTTP_FORM_PARAM[] PROGMEM      = "<br/><input id='{i}' name='{n}' length={l} placeholder='{p}' value='{v}'>";
-const char CPHTTP_FORM_END[] PROGMEM        = "<br/><button type='submit'>save</button></form>";
-const char CPHTTP_SCAN_LINK[] PROGMEM       = "<br/><div class=\"c\"><a href=\"/wifi\">Scan</a></div>";
-const char CPHTTP_END[] PROGMEM             = "</div></body></html>";
+#include "PortalHtml.h"
 
 struct WiFiEEPromData{
   bool APSTA = true;            // Access Point or Station Mode - true AP Mode
@@ -85,6 +82,20 @@ WiFiEEPromData MyWiFiConfig;
 unsigned long currentMillis = 0;
 unsigned long startMillis;
 
+/* Firmware update */
+class UpdatePartition : public PartitionWriter {
+  public:
+    bool begin() { return Update.begin(UPDATE_SIZE_UNKNOWN, U_FLASH); }
+    size_t write(const uint8_t* data, size_t len) { return Update.write((uint8_t*)data, len); }
+    bool end() { return Update.end(true); }
+    void abort() { Update.abort(); }
+    bool isRunning() { return Update.isRunning(); }
+    uint8_t error() { return Update.getError(); }
+};
+UpdatePartition OTAPartition;
+FirmwareWriter OTAWriter(OTAPartition);
+size_t OTANextProgress = 0;
+
 /** Current WLAN status */
 short status = WL_IDLE_STATUS;
 
@@ -123,6 +134,95 @@ int getRSSIasQuality(int RSSI) {
   return quality;
 }
 
+// Pass compressed data as HTTP chunk to the client
+void sendGzipChunk(const uint8_t* data, size_t len) {
+  server.sendContent((const char*)data, len);
+}
+
+// Send a dynamic page part by part as chunked response, gzip compressed if the client accepts it.
+// Only the encoder or one segment buffer is held in RAM, never the complete page.
+class PageStream {
+  public:
+    // sizeHint is a lower bound of the body size, used to skip compression of small bodies
+    explicit PageStream(size_t sizeHint) {
+      if (sizeHint >= GzipMinSize && server.header("Accept-Encoding").indexOf("gzip") >= 0) {
+        _gz = new (std::nothrow) GzipStream(sendGzipChunk);
+      }
+      if (_gz != NULL) {
+        server.sendHeader("Content-Encoding", "gzip");
+        server.sendHeader("Vary", "Accept-Encoding");
+      }
+      else { // Not accepted, too small or no memory
+        _buf = new (std::nothrow) char[GzipStream::OutSize];
+      }
+      server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+      server.send(200, "text/html", "");
+    }
+
+    ~PageStream() {
+      end();
+    }
+
+    void write(const char* part, size_t len) {
+      if (_gz != NULL) {
+        _gz->write((const uint8_t*)part, len);
+      }
+      else if (_buf == NULL) {
+        server.sendContent(part, len);
+      }
+      else {
+        // Collect small parts to one TCP segment
+        while (len > 0) {
+          size_t n = GzipStream::OutSize - _len < len ? GzipStream::OutSize - _len : len;
+          memcpy(&_buf[_len], part, n);
+          _len += n;
+          part += n;
+          len -= n;
+          if (_len == GzipStream::OutSize) {
+            flush();
+          }
+        }
+      }
+    }
+
+    void write(const char* part) {
+      write(part, strlen(part));
+    }
+
+    void write(const String& part) {
+      write(part.c_str(), part.length());
+    }
+
+    void end() {
+      if (_ended) {
+        return;
+      }
+      _ended = true;
+      if (_gz != NULL) {
+        _gz->finish();
+        delete _gz;
+        _gz = NULL;
+      }
+      flush();
+      delete[] _buf;
+      _buf = NULL;
+      server.sendContent(""); // Terminate chunked transfer
+    }
+
+  private:
+    void flush() {
+      if (_len > 0) {
+        server.sendContent(_buf, _len);
+        _len = 0;
+      }
+    }
+
+    GzipStream* _gz = NULL;
+    char* _buf = NULL;
+    size_t _len = 0;
+    bool _ended = false;
+};
+
 // Store WLAN credentials to EEPROM
 int saveCredentials() {
   int RetValue;
@@ -176,7 +276,7 @@ void handleCP() {
 // Redirect to captive portal if we got a request for another domain. Return true in that case so the page handler do not try to handle the request again.
 boolean captivePortal() {
   if ((!isIp(server.hostHeader()) && server.hostHeader() != (String(MyWiFiConfig.HostName)+".local")) || server.hostHeader()==toStringIp(CPapIP)) {
-    Serial.println("Request redirected to captive portal");  
+    CPLOG_I(EV_CP_REDIRECT);
     handleCP();
     return true;
   }
@@ -268,17 +368,22 @@ void handleWifi(boolean scan) {
   else if(sip == "false") {
     MyWiFiConfig.StaticIP = 0;
   }
-  String page = FPSTR(CPHTTP_HEAD);
-  page.replace("{v}", "Config ESP");
-  page += FPSTR(CPHTTP_SCRIPT);
-  page += FPSTR(CPHTTP_STYLE);
-  //page += _customHeadElement;
-  page += FPSTR(CPHTTP_HEAD_END);
+  // The fixed parts alone are larger than GzipMinSize
+  size_t sizeHint = strlen(CPHTTP_HEAD) + strlen(CPHTTP_SCRIPT) + strlen(CPHTTP_STYLE) + strlen(CPHTTP_HEAD_END)
+                  + strlen(CPHTTP_FORM_START) + strlen(CPHTTP_FORM_END) + strlen(CPHTTP_SCAN_LINK) + strlen(CPHTTP_END);
+  PageStream page(sizeHint);
+  String head = FPSTR(CPHTTP_HEAD);
+  head.replace("{v}", "Config ESP");
+  page.write(head);
+  page.write(CPHTTP_SCRIPT);
+  page.write(CPHTTP_STYLE);
+  //page.write(_customHeadElement);
+  page.write(CPHTTP_HEAD_END);
 
   if (scan) {
     int n = WiFi.scanNetworks();
     if (n == 0) {
-      page += F("No networks found. Refresh to scan again.");
+      page.write("No networks found. Refresh to scan again.");
     } else {
 
       //sort networks
@@ -327,11 +432,11 @@ void handleWifi(boolean scan) {
             item.replace("{i}", "");
           }
           //DEBUG_WM(item);
-          page += item;
+          page.write(item);
           delay(0);
         } 
       }
-      page += "<br/>";
+      page.write("<br/>");
     }
   }
 
@@ -346,7 +451,7 @@ void handleWifi(boolean scan) {
       temp = MyWiFiConfig.HostName;
       item.replace("'hostname'", "'hostname' value='" + temp + "'");
     }
-    page += item;
+    page.write(item);
   }
   else {
     String item = FPSTR(CPHTTP_FORM_START);
@@ -358,7 +463,7 @@ void handleWifi(boolean scan) {
       temp = MyWiFiConfig.HostName;
       item.replace("'hostname'", "'hostname' value='" + temp + "'");
     }
-    page += item;
+    page.write(item);
   }
 
   if (MyWiFiConfig.StaticIP > 0) {
@@ -375,7 +480,7 @@ void handleWifi(boolean scan) {
       item.replace("{v}", "");
     }
     
-    page += item;
+    page.write(item);
 
     item = FPSTR(CPHTTP_FORM_PARAM);
     item.replace("{i}", "gw");
@@ -389,7 +494,7 @@ void handleWifi(boolean scan) {
       item.replace("{v}", "");
     }
 
-    page += item;
+    page.write(item);
 
     item = FPSTR(CPHTTP_FORM_PARAM);
     item.replace("{i}", "sn");
@@ -403,7 +508,7 @@ void handleWifi(boolean scan) {
       item.replace("{v}", "");
     }
 
-    page += item;
+    page.write(item);
 
     item = FPSTR(CPHTTP_FORM_PARAM);
     item.replace("{i}", "dns");
@@ -417,17 +522,16 @@ void handleWifi(boolean scan) {
       item.replace("{v}", "");
     }
 
-    page += item;
-    page += "<br/>";
+    page.write(item);
+    page.write("<br/>");
   }
 
-  page += FPSTR(CPHTTP_FORM_END);
-  page += FPSTR(CPHTTP_SCAN_LINK);
+  page.write(CPHTTP_FORM_END);
+  page.write(CPHTTP_SCAN_LINK);
 
-  page += FPSTR(CPHTTP_END);
+  page.write(CPHTTP_END);
 
-  server.sendHeader("Content-Length", String(page.length()));
-  server.send(200, "text/html", page);
+  page.end();
 }
 
 // Wifi handler with scan
@@ -484,16 +588,16 @@ void handleWifiSave(){
     // Static IP needs at least IP; GW and SUBNET 
     if (_ip != "" && isIp(_ip) && _gw != "" && isIp(_gw) && _sn != "" && isIp(_sn)){
       MyWiFiConfig.IPAdd.fromString(_ip);
-      Serial.println("IP: " + toStringIp(MyWiFiConfig.IPAdd));
+      CPLOG_I(EV_STATIC_IP, (uint32_t)MyWiFiConfig.IPAdd);
       MyWiFiConfig.Gate.fromString(_gw);
-      Serial.println("GW: " + toStringIp(MyWiFiConfig.Gate));
+      CPLOG_I(EV_STATIC_GW, (uint32_t)MyWiFiConfig.Gate);
       MyWiFiConfig.SubNet.fromString(_sn);
-      Serial.println("SN: " + toStringIp(MyWiFiConfig.SubNet));
+      CPLOG_I(EV_STATIC_SN, (uint32_t)MyWiFiConfig.SubNet);
       MyWiFiConfig.StaticIP = 2;
     }
     if (_dns != "" && isIp(_dns) && MyWiFiConfig.StaticIP == 2) {
       MyWiFiConfig.DNS.fromString(_dns);
-      Serial.println("DNS: " + toStringIp(MyWiFiConfig.DNS));
+      CPLOG_I(EV_STATIC_DNS, (uint32_t)MyWiFiConfig.DNS);
       MyWiFiConfig.StaticIP = 3;
     }
   }
@@ -531,13 +635,81 @@ void handleWifiSave(){
   }
 }
 
+// Firmware update page
+void handleUpdate() {
+  String page = FPSTR(CPHTTP_HEAD);
+  page.replace("{v}", "Firmware Update");
+  page += FPSTR(CPHTTP_SCRIPT);
+  page += FPSTR(CPHTTP_STYLE);
+  page += FPSTR(CPHTTP_HEAD_END);
+  page += F("<h3>Firmware Update</h3>");
+  page += FPSTR(CPHTTP_UPDATE_FORM);
+  page += FPSTR(CPHTTP_END);
+
+  server.sendHeader("Content-Length", String(page.length()));
+  server.send(200, "text/html", page);
+}
+
+// Stream the uploaded image chunk by chunk into the inactive OTA partition. 
+// Only one upload buffer and the 4 KB flash sector buffer of Update are in RAM at any time.
+void handleUpdateUpload() {
+  HTTPUpload& upload = server.upload();
+  switch (upload.status) {
+    case UPLOAD_FILE_START:
+      OTANextProgress = OTAProgressStep;
+      CPLOG_I(EV_OTA_START);
+      OTAWriter.begin(server.arg("sha256").c_str());
+      break;
+    case UPLOAD_FILE_WRITE:
+      if (OTAWriter.write(upload.buf, upload.currentSize) && OTAWriter.written() >= OTANextProgress) {
+        CPLOG_I(EV_OTA_PROGRESS, OTAWriter.written());
+        OTANextProgress += OTAProgressStep;
+      }
+      break;
+    case UPLOAD_FILE_END:
+      OTAWriter.end();
+      break;
+    case UPLOAD_FILE_ABORTED:
+      OTAWriter.abort("Upload aborted");
+      break;
+  }
+}
+
+// Report result of firmware update and boot the new image
+void handleUpdateDone() {
+  String page;
+  bool success = OTAWriter.success();
+  const char* result = success ? "successful" : (OTAWriter.error() != NULL ? OTAWriter.error() : "no image received");
+  CPLOG_I(EV_OTA_RESULT, (uintptr_t)result, OTAWriter.partitionError());
+  if (success) {
+    page = "Success! Rebooting in 2s";
+  }
+  else {
+    page = "Update failed: " + String(result);
+    if (OTAWriter.partitionError() != 0) {
+      page += ", error " + String(OTAWriter.partitionError());
+    }
+  }
+  server.sendHeader("Content-Length", String(page.length()));
+  server.send(200, "text/html", page);
+  OTAWriter.reset();
+  if (success){
+    delay(2000);
+    ESP.restart();
+  }
+}
+
 void InitalizeHTTPServer() {
+  const char* headerKeys[] = {"Accept-Encoding"};
+  server.collectHeaders(headerKeys, 1); // Needed for gzip compression of dynamic pages
   // Setup web pages: root, wifi config pages, SO captive portal detectors and not found.
   server.on("/", handleRoot);
   server.on("/wifi", handleWifi1);
   server.on("/0wifi", handleWifi0);
   server.on("/wifisave", handleWifiSave);
   server.on("/reset", handleReset);
+  server.on("/update", HTTP_GET, handleUpdate);
+  server.on("/update", HTTP_POST, handleUpdateDone, handleUpdateUpload);
 
   if (MyWiFiConfig.CapPortal) { server.on("/generate_204", handleCP); } //Android captive portal. Maybe not needed. Might be handled by notFound handler.
   if (MyWiFiConfig.CapPortal) { server.on("/favicon.ico", handleCP); }   //Another Android captive portal. Maybe not needed. Might be handled by notFound handler. Checked on Sony Handy
@@ -572,7 +744,7 @@ boolean CreateWifiSoftAP() {
 }
 
 byte ConnectWifiAP() {
-  Serial.println(F("Initalizing Wifi Client."));  
+  CPLOG_I(EV_STA_INIT);
   byte connRes = 0;
   byte retry = 0;
   WiFi.disconnect();
@@ -595,7 +767,7 @@ byte ConnectWifiAP() {
       connRes  = WiFi.waitForConnectResult();
       delay(2000);
       retry++;
-      Serial.print(F("."));
+      CPLOG_I(EV_STA_RETRY, retry, connRes);
       // statement(s)
     }
   while (( connRes == 1 ) and (retry != 10))  //if connRes == 1  NO_SSID_AVAILin - SSID cannot be reached
@@ -603,13 +775,13 @@ byte ConnectWifiAP() {
       connRes  = WiFi.waitForConnectResult();
       delay(2000);
       retry++;
-      Serial.print(F("."));
+      CPLOG_I(EV_STA_RETRY, retry, connRes);
     }
   if (connRes == 3 ) { 
     WiFi.setAutoReconnect(true); // Set whether module will attempt to reconnect to an access point in case it is disconnected.
     // Setup MDNS responder
     if (!MDNS.begin(MyWiFiConfig.HostName)) {
-      Serial.println(F("Error: MDNS"));
+      CPLOG_E(EV_MDNS_ERROR);
     } 
     else {
       MDNS.addService("http", "tcp", 80); 
@@ -621,15 +793,13 @@ byte ConnectWifiAP() {
       connRes = WiFi.waitForConnectResult();
       delay(3000);
       retry++;
-      Serial.print(F("."));                 
+      CPLOG_I(EV_STA_RETRY, retry, connRes);
     }
   if (connRes == 4 ) {  
-    Serial.println(F("STA Pwd Err"));                     
-    Serial.println(MyWiFiConfig.APSTAName);
-    Serial.println(MyWiFiConfig.WiFiPwd); 
+    CPLOG_E(EV_STA_PWD_ERROR);
     WiFi.disconnect();
   }
-  Serial.println("");
+  CPLOG_I(EV_STA_RESULT, connRes);
   return connRes;
 }
 
@@ -658,6 +828,7 @@ void setup() {
     ; // wait for serial port to connect. Needed for native USB
   }
   Serial.println(F("Serial Interface initalized at 115200 Baud. v0.2")); 
+  logBegin();
   WiFi.setAutoReconnect (false);
   WiFi.persistent(false);
   WiFi.disconnect(); 
@@ -689,6 +860,7 @@ void setup() {
      Serial.println(F("NO Valid Credentials found.")); 
      handleReset();  
   }
+  logFlush(); // Print the queued connect messages before the direct output below
   if ((CPConnectSuccess or CPCreateSoftAPSucc))
     {         
       Serial.print (F("IP Address: "));
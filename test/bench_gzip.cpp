@@ -0,0 +1,138 @@
+/*
+ *  Host benchmark of GzipStream for /wifi pages with 5 to 60 networks.
+ *  The pages are built from the templates in PortalHtml.h and fed to the encoder in the
+ *  same parts as handleWifi writes them.
+ *
+ *  g++ -O2 -Wall -Wextra -Isrc test/bench_gzip.cpp src/GzipStream.cpp -lz -o bench_gzip
+ *  ./bench_gzip
+*/
+
+#define PROGMEM
+#include "PortalHtml.h"
+#include "GzipStream.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+static std::vector<uint8_t> out;
+static size_t chunks = 0;
+
+static void sink(const uint8_t* data, size_t len) {
+  out.insert(out.end(), data, data + len);
+  chunks++;
+}
+
+static void replace(std::string& s, const std::string& from, const std::string& to) {
+  for (size_t pos = s.find(from); pos != std::string::npos; pos = s.find(from, pos + to.size())) {
+    s.replace(pos, from.size(), to);
+  }
+}
+
+static std::string formParam(const char* id, const char* placeholder, const char* value) {
+  std::string item = CPHTTP_FORM_PARAM;
+  replace(item, "{i}", id);
+  replace(item, "{n}", id);
+  replace(item, "{p}", placeholder);
+  replace(item, "{l}", "15");
+  replace(item, "{v}", value);
+  return item;
+}
+
+// Parts written by handleWifi(true) for a scan result of n networks
+static std::vector<std::string> wifiPage(int n, bool staticIP) {
+  static const char* vendors[] = {"FRITZ!Box 7590 ", "Vodafone-", "TP-Link_", "o2-WLAN", "DIRECT-", "HUAWEI-", "MagentaWLAN-", "Guest "};
+  std::vector<std::string> page;
+  std::string head = CPHTTP_HEAD;
+  replace(head, "{v}", "Config ESP");
+  page.push_back(head);
+  page.push_back(CPHTTP_SCRIPT);
+  page.push_back(CPHTTP_STYLE);
+  page.push_back(CPHTTP_HEAD_END);
+  for (int i = 0; i < n; i++) {
+    char ssid[40];
+    snprintf(ssid, sizeof(ssid), "%s%X", vendors[rand() % 8], rand() % 0xFFFF);
+    std::string item = CPHTTP_ITEM;
+    replace(item, "{v}", ssid);
+    replace(item, "{r}", std::to_string(100 - i * 90 / n));
+    replace(item, "{i}", rand() % 5 ? "l" : "");
+    page.push_back(item);
+  }
+  page.push_back("<br/>");
+  std::string item = CPHTTP_FORM_START;
+  if (staticIP) {
+    replace(item, "> S", " checked> S");
+  }
+  replace(item, "'SSID'", "'SSID' value='HomeNetwork'");
+  page.push_back(item);
+  if (staticIP) {
+    page.push_back(formParam("ip", "Static IP", "192.168.178.50"));
+    page.push_back(formParam("gw", "Static Gateway", "192.168.178.1"));
+    page.push_back(formParam("sn", "Subnet", "255.255.255.0"));
+    page.push_back(formParam("dns", "DNS", "192.168.178.1"));
+    page.push_back("<br/>");
+  }
+  page.push_back(CPHTTP_FORM_END);
+  page.push_back(CPHTTP_SCAN_LINK);
+  page.push_back(CPHTTP_END);
+  return page;
+}
+
+static bool roundTrip(const std::string& page) {
+  std::vector<uint8_t> plain(page.size() + 1);
+  z_stream z = {};
+  inflateInit2(&z, 16 + MAX_WBITS);
+  z.next_in = out.data();
+  z.avail_in = out.size();
+  z.next_out = plain.data();
+  z.avail_out = plain.size();
+  int ret = inflate(&z, Z_FINISH);
+  inflateEnd(&z);
+  return ret == Z_STREAM_END && z.total_out == page.size() && page.compare(0, page.size(), (const char*)plain.data(), page.size()) == 0;
+}
+
+static size_t zlibSize(const std::string& page) {
+  uLongf len = compressBound(page.size());
+  std::vector<uint8_t> buf(len);
+  compress2(buf.data(), &len, (const uint8_t*)page.data(), page.size(), 6);
+  return len + 12; // gzip header and trailer instead of zlib ones
+}
+
+int main() {
+  static const int networks[] = {5, 10, 20, 40, 60};
+  const int runs = 2000;
+  int failures = 0;
+  srand(1);
+  printf("Encoder: %zu bytes\n", sizeof(GzipStream));
+  printf("networks static   page   gzip  saved  chunks  us/page  ns/saved byte  zlib -6  largest part\n");
+  for (int staticIP = 0; staticIP < 2; staticIP++) {
+    for (int n : networks) {
+      std::vector<std::string> parts = wifiPage(n, staticIP);
+      std::string page;
+      size_t largest = 0;
+      for (const std::string& part : parts) {
+        page += part;
+        largest = part.size() > largest ? part.size() : largest;
+      }
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < runs; i++) {
+        out.clear();
+        chunks = 0;
+        GzipStream gz(sink);
+        for (const std::string& part : parts) {
+          gz.write((const uint8_t*)part.data(), part.size());
+        }
+        gz.finish();
+      }
+      double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / runs;
+      bool ok = roundTrip(page);
+      failures += ok ? 0 : 1;
+      size_t saved = page.size() - out.size();
+      printf("%8d %6s %6zu %6zu %5.1f%% %7zu %8.1f %14.1f %8zu %13zu%s\n", n, staticIP ? "on" : "off", page.size(), out.size(),
+             100.0 * saved / page.size(), chunks, ns / 1000, ns / saved, zlibSize(page), largest, ok ? "" : "  ROUND TRIP FAILED");
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+/*
+ *  Host benchmark of the per call cost of the event log.
+ *
+ *  g++ -std=c++17 -O2 -Wall -Wextra -Itest/host -Isrc test/bench_log.cpp src/EventLog.cpp -pthread -o bench_log
+ *  ./bench_log
+*/
+
+#include "Arduino.h"
+#include "EventLog.h"
+#include <string.h>
+
+using Clock = std::chrono::steady_clock;
+
+static double nsPerCall(Clock::duration d, long calls) {
+  return std::chrono::duration<double, std::nano>(d).count() / calls;
+}
+
+int main() {
+  int failures = 0;
+
+  // Events queued before the log task runs are printed in order, the rest is counted as dropped
+  Serial.Echo = true;
+  CPLOG_I(EV_STATIC_IP, 0x32B2A8C0u);
+  CPLOG_I(EV_STA_RETRY, 3, 1);
+  CPLOG_E(EV_STA_PWD_ERROR);
+  CPLOG_I(EV_OTA_RESULT, (uintptr_t)"SHA-256 mismatch", 0);
+  for (int i = 0; i < 69; i++) {
+    CPLOG_I(EV_CP_REDIRECT);
+  }
+  if (logDropped() != 9) {
+    printf("FAIL: %u events dropped, expected 9\n", logDropped());
+    failures++;
+  }
+
+  // Drop path: ring is full, nothing drains it yet
+  const long calls = 10000000;
+  Clock::time_point start = Clock::now();
+  for (long i = 0; i < calls; i++) {
+    CPLOG_I(EV_CP_REDIRECT);
+  }
+  double dropNs = nsPerCall(Clock::now() - start, calls);
+
+  // Compiled out: CPLOG_D with the default CPLOG_LEVEL_INFO
+  start = Clock::now();
+  for (long i = 0; i < calls; i++) {
+    CPLOG_D(EV_CP_REDIRECT);
+  }
+  double offNs = nsPerCall(Clock::now() - start, calls);
+
+  logBegin();
+  logFlush();
+  if (Serial.Lines < 64) { // All queued events, the drop report may follow
+    printf("FAIL: %zu lines printed after logFlush(), expected at least 64\n", Serial.Lines.load());
+    failures++;
+  }
+  Serial.Echo = false;
+
+  // Queue path: batches smaller than the ring, the log task drains it in between
+  const int batch = 32;
+  const int batches = 500;
+  uint32_t dropped = logDropped();
+  Clock::duration queued = Clock::duration::zero();
+  for (int b = 0; b < batches; b++) {
+    start = Clock::now();
+    for (int i = 0; i < batch; i++) {
+      CPLOG_I(EV_STA_RETRY, i, b);
+    }
+    queued += Clock::now() - start;
+    logFlush();
+  }
+  double queueNs = nsPerCall(queued, (long)batch * batches);
+  if (logDropped() != dropped) {
+    printf("FAIL: %u events dropped while the log task was running\n", logDropped() - dropped);
+    failures++;
+  }
+
+  printf("queued:       %6.1f ns/call\n", queueNs);
+  printf("ring full:    %6.1f ns/call\n", dropNs);
+  printf("compiled out: %6.1f ns/call\n", offNs);
+  printf("printed %zu lines, %zu bytes\n", Serial.Lines.load(), Serial.Bytes.load());
+  return failures == 0 ? 0 : 1;
+}
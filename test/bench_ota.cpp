@@ -0,0 +1,212 @@
+/*
+ *  Host test and benchmark of the OTA flash write path (FirmwareWriter)
+ *  against a simulated partition in RAM, or in a file if a path is given.
+ *
+ *  g++ -O2 -Wall -Wextra -Itest/host -Isrc test/bench_ota.cpp src/FirmwareWriter.cpp -lcrypto -o bench_ota
+ *  ./bench_ota [partition-file]
+*/
+
+#include "FirmwareWriter.h"
+#include <chrono>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const size_t PartitionSize = 0x1E0000;   // OTA slot of the default ESP32 partition table
+static const size_t SectorSize = 4096;
+static const size_t ChunkSize = 1436;           // HTTP_UPLOAD_BUFLEN of WebServer
+
+// Buffers a flash sector like Update and erases each sector before it is written
+class SimPartition : public PartitionWriter {
+  public:
+    explicit SimPartition(const char* path, size_t size = PartitionSize) : _size(size) {
+      if (path != NULL) {
+        _file = fopen(path, "w+b");
+      }
+      else {
+        _flash.resize(size);
+      }
+    }
+    ~SimPartition() { if (_file) fclose(_file); }
+
+    bool begin() {
+      if (_running) {
+        _error = 10; // UPDATE_ERROR_BAD_ARGUMENT, like Update when already running
+        return false;
+      }
+      _running = true;
+      _bootable = false;
+      _offset = 0;
+      _fill = 0;
+      _error = 0;
+      return true;
+    }
+    size_t write(const uint8_t* data, size_t len) {
+      if (!_running || _offset + _fill + len > _size) {
+        _error = 4; // UPDATE_ERROR_SPACE
+        return 0;
+      }
+      for (size_t done = 0; done < len; ) {
+        size_t n = SectorSize - _fill < len - done ? SectorSize - _fill : len - done;
+        memcpy(&_sector[_fill], data + done, n);
+        _fill += n;
+        done += n;
+        if (_fill == SectorSize) {
+          flushSector();
+        }
+      }
+      return len;
+    }
+    bool end() {
+      if (!_running) {
+        return false;
+      }
+      flushSector();
+      _running = false;
+      _bootable = true;
+      return true;
+    }
+    void abort() { _running = false; }
+    bool isRunning() { return _running; }
+    uint8_t error() { return _error; }
+
+    bool bootable() const { return _bootable; }
+    bool contains(const std::vector<uint8_t>& image) {
+      std::vector<uint8_t> data(image.size());
+      if (_file) {
+        fseek(_file, 0, SEEK_SET);
+        if (fread(data.data(), 1, data.size(), _file) != data.size()) {
+          return false;
+        }
+      }
+      else {
+        memcpy(data.data(), _flash.data(), data.size());
+      }
+      return data == image;
+    }
+
+  private:
+    void flushSector() {
+      if (_fill == 0) {
+        return;
+      }
+      memset(&_sector[_fill], 0xFF, SectorSize - _fill);
+      if (_file) {
+        fseek(_file, _offset, SEEK_SET);
+        fwrite(_sector, 1, SectorSize, _file);
+      }
+      else {
+        memset(&_flash[_offset], 0xFF, SectorSize); // Erase
+        memcpy(&_flash[_offset], _sector, SectorSize);
+      }
+      _offset += SectorSize;
+      _fill = 0;
+    }
+
+    size_t _size;
+    FILE* _file = NULL;
+    std::vector<uint8_t> _flash;
+    uint8_t _sector[SectorSize];
+    size_t _offset = 0;
+    size_t _fill = 0;
+    bool _running = false;
+    bool _bootable = false;
+    uint8_t _error = 0;
+};
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  printf("%s: %s\n", ok ? "ok  " : "FAIL", what);
+  if (!ok) {
+    failures++;
+  }
+}
+
+static std::string sha256Hex(const std::vector<uint8_t>& data) {
+  unsigned char digest[32];
+  char hex[65];
+  mbedtls_sha256_context sha;
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+  mbedtls_sha256_update(&sha, data.data(), data.size());
+  mbedtls_sha256_finish(&sha, digest);
+  mbedtls_sha256_free(&sha);
+  for (int i = 0; i < 32; i++) {
+    sprintf(&hex[i * 2], "%02x", digest[i]);
+  }
+  return std::string(hex, 64);
+}
+
+// Feed the image like the upload handler does
+static bool upload(FirmwareWriter& writer, const std::vector<uint8_t>& image, const char* sha256) {
+  if (!writer.begin(sha256)) {
+    return false;
+  }
+  for (size_t i = 0; i < image.size(); i += ChunkSize) {
+    size_t n = image.size() - i < ChunkSize ? image.size() - i : ChunkSize;
+    writer.write(&image[i], n);
+  }
+  return writer.end();
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : NULL;
+  std::vector<uint8_t> image(1200 * 1024 + 123);
+  srand(1);
+  for (size_t i = 0; i < image.size(); i++) {
+    image[i] = rand() & 0xFF;
+  }
+  std::string hash = sha256Hex(image);
+  std::string upper = hash;
+  for (size_t i = 0; i < upper.size(); i++) {
+    upper[i] = toupper(upper[i]);
+  }
+  std::string wrong = hash;
+  wrong[0] = wrong[0] == '0' ? '1' : '0';
+
+  {
+    SimPartition partition(path);
+    FirmwareWriter writer(partition);
+    check(upload(writer, image, upper.c_str()) && writer.success(), "valid image is committed");
+    check(partition.bootable() && partition.contains(image), "partition holds the image");
+    writer.reset();
+    check(!writer.success() && writer.error() == NULL, "reset clears the result");
+  }
+  {
+    SimPartition partition(path);
+    FirmwareWriter writer(partition);
+    check(!upload(writer, image, wrong.c_str()) && !partition.bootable(), "hash mismatch is not committed");
+    check(writer.error() != NULL && strcmp(writer.error(), "SHA-256 mismatch") == 0, "hash mismatch is reported");
+    check(!upload(writer, image, "") && !partition.isRunning(), "missing hash is rejected");
+    check(!upload(writer, image, (std::string(63, 'a') + "g").c_str()), "invalid hash is rejected");
+  }
+  {
+    SimPartition partition(path);
+    FirmwareWriter writer(partition);
+    writer.begin(hash.c_str());
+    writer.write(image.data(), ChunkSize); // Upload which never finished
+    check(upload(writer, image, hash.c_str()) && partition.contains(image), "stale session is replaced");
+  }
+  {
+    SimPartition partition(path, image.size() / 2);
+    FirmwareWriter writer(partition);
+    check(!upload(writer, image, hash.c_str()) && !partition.bootable() && writer.partitionError() == 4, "oversized image fails");
+  }
+
+  // Throughput of hash and write per upload chunk
+  SimPartition partition(path);
+  FirmwareWriter writer(partition);
+  const int runs = 20;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; i++) {
+    upload(writer, image, hash.c_str());
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("%s partition: %.1f MB/s (%zu byte image, %zu byte chunks, %d runs)\n",
+         path ? "File" : "RAM", runs * image.size() / seconds / 1e6, image.size(), ChunkSize, runs);
+  return failures == 0 ? 0 : 1;
+}
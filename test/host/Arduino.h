@@ -0,0 +1,51 @@
+// Host stand-in for the parts of the Arduino core and FreeRTOS used by EventLog.cpp
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <atomic>
+#include <chrono>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+
+inline uint32_t millis() {
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Collects output instead of writing to a UART, set Echo to print it on stdout
+struct HostSerial {
+  bool Echo = false;
+  std::atomic<size_t> Bytes{0};
+  std::atomic<size_t> Lines{0};
+
+  int printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    Bytes += len;
+    Lines++;
+    if (Echo) {
+      fputs(buf, stdout);
+    }
+    return len;
+  }
+};
+inline HostSerial Serial;
+
+#define tskIDLE_PRIORITY 0
+#define pdMS_TO_TICKS(ms) (ms)
+
+inline void vTaskDelay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline int xTaskCreatePinnedToCore(void (*task)(void*), const char*, uint32_t, void* param, int, void*, int) {
+  std::thread(task, param).detach();
+  return 1;
+}
+
+#endif
@@ -0,0 +1,18 @@
+// Host stand-in for the mbedtls SHA-256 API of the ESP32 core, backed by OpenSSL
+#ifndef HOST_MBEDTLS_SHA256_H
+#define HOST_MBEDTLS_SHA256_H
+
+#include <stddef.h>
+#include <openssl/evp.h>
+
+typedef struct {
+  EVP_MD_CTX* ctx;
+} mbedtls_sha256_context;
+
+inline void mbedtls_sha256_init(mbedtls_sha256_context* c) { c->ctx = EVP_MD_CTX_new(); }
+inline void mbedtls_sha256_free(mbedtls_sha256_context* c) { EVP_MD_CTX_free(c->ctx); c->ctx = NULL; }
+inline int mbedtls_sha256_starts(mbedtls_sha256_context* c, int) { return EVP_DigestInit_ex(c->ctx, EVP_sha256(), NULL) == 1 ? 0 : -1; }
+inline int mbedtls_sha256_update(mbedtls_sha256_context* c, const unsigned char* data, size_t len) { return EVP_DigestUpdate(c->ctx, data, len) == 1 ? 0 : -1; }
+inline int mbedtls_sha256_finish(mbedtls_sha256_context* c, unsigned char out[32]) { return EVP_DigestFinal_ex(c->ctx, out, NULL) == 1 ? 0 : -1; }
+
+#endif